@@ -0,0 +1,346 @@
+// Phase benchmarks for enwiki_pagerank.cpp on synthetic graphs. Generates a deterministic
+// R-MAT power-law edge list in the WikiLinkGraphs TSV format, then times each stage of the
+// pipeline on its own: line parsing, ID mapping, degree counting, the full ingest, one
+// PageRank sweep, top-k selection and JSON writing. Results (best time, throughput, peak RSS)
+// go to a JSON file so runs can be compared over time.
+//
+//   make bench BENCH_ARGS="--scale 20 --repeat 5"
+
+#define ENWIKI_PAGERANK_NO_MAIN
+#include "enwiki_pagerank.cpp"
+
+#include <sys/resource.h>
+
+// R-MAT quadrant probabilities (Chakrabarti et al.); d = 1 - a - b - c
+const double RMAT_A = 0.57;
+const double RMAT_B = 0.19;
+const double RMAT_C = 0.19;
+
+// Swallows the pipeline's progress output while a phase is timed
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+};
+
+class PageRankBench {
+public:
+    int scale = 17;
+    int edge_factor = 16;
+    uint64_t seed = 1;
+    int repeat = 3;
+    int threads = 0; // 0 = all cores
+    std::string directory = "bench";
+    std::string results_filename;
+
+    void run() {
+        std::filesystem::create_directories(directory);
+        std::string graph_filename = directory + "/rmat-s" + std::to_string(scale) + "-e" + std::to_string(edge_factor)
+                                   + "-seed" + std::to_string(seed) + ".csv";
+        if (results_filename.empty()) {
+            results_filename = directory + "/results-s" + std::to_string(scale) + ".json";
+        }
+        if (threads <= 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        bool generated = !std::filesystem::exists(graph_filename);
+        if (generated) {
+            std::cout << "🎲 Generating R-MAT graph: scale " << scale << ", edge factor " << edge_factor << ", seed " << seed << "..." << std::endl;
+            generateRmat(graph_filename);
+        }
+        double generate_seconds = secondsSince(start);
+        uint64_t file_bytes = std::filesystem::file_size(graph_filename);
+        std::cout << "📄 " << graph_filename << " (" << file_bytes / 1024 / 1024 << " MB"
+                  << (generated ? ", generated in " + std::to_string((int)(generate_seconds * 1000)) + "ms" : ", reused") << ")" << std::endl;
+
+        benchParse(graph_filename, file_bytes);
+        benchIdMap();
+        benchDegreeCount();
+        benchIngest(graph_filename, file_bytes);
+        benchSweep();
+        benchTopK();
+        benchJson();
+
+        // Results
+        JsonWriter json;
+        json << "{\n";
+        json << "  \"graph\": {\"generator\": \"rmat\", \"scale\": " << scale << ", \"edge_factor\": " << edge_factor
+             << ", \"seed\": " << seed << ", \"nodes\": " << nodes << ", \"edges\": " << edge_count
+             << ", \"file\": " << JsonWriter::quoted(graph_filename) << ", \"bytes\": " << file_bytes << "},\n";
+        json << "  \"threads\": " << threads << ",\n";
+        json << "  \"repeat\": " << repeat << ",\n";
+        json << "  \"simd\": \"" << SIMD_PATH << "\",\n";
+        json << "  \"phases\": [\n";
+        for (size_t i = 0; i < phases.size(); i++) {
+            const Phase& phase = phases[i];
+            if (i > 0) json << ",\n";
+            json << "    {\"name\": \"" << phase.name << "\", \"seconds\": " << JsonWriter::scientific(phase.best_seconds)
+                 << ", \"mean_seconds\": " << JsonWriter::scientific(phase.mean_seconds)
+                 << ", \"items\": " << phase.items << ", \"unit\": \"" << phase.unit << "\""
+                 << ", \"items_per_second\": " << JsonWriter::scientific(phase.items / phase.best_seconds)
+                 << ", \"mb_per_second\": " << JsonWriter::fixed(phase.bytes / phase.best_seconds / 1e6, 1)
+                 << ", \"peak_rss_mb\": " << JsonWriter::fixed(phase.peak_rss_mb, 1) << "}";
+        }
+        json << "\n  ]\n}\n";
+        std::ofstream file(results_filename);
+        file << json.take();
+        if (!file) {
+            throw std::runtime_error("Cannot write " + results_filename);
+        }
+        std::cout << "💾 Results saved to " << results_filename << std::endl;
+    }
+
+private:
+    struct Phase {
+        std::string name;
+        std::string unit;
+        double best_seconds = 0;
+        double mean_seconds = 0;
+        uint64_t items = 0;
+        uint64_t bytes = 0; // Input or output bytes for mb_per_second, 0 if not meaningful
+        double peak_rss_mb = 0;
+    };
+    std::vector<Phase> phases;
+
+    // State handed from one phase to the next
+    int nodes = 0;
+    int64_t edge_count = 0;
+    std::vector<int> edge_wiki_ids; // Interleaved (from, to) from the parse phase
+    std::vector<int> unique_ids;    // Ascending
+    std::vector<int> dense_edges;   // edge_wiki_ids mapped to dense IDs
+    std::unique_ptr<StreamingENWikiPageRank> pagerank;
+
+    static double secondsSince(std::chrono::high_resolution_clock::time_point since) {
+        return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - since).count();
+    }
+
+    static double peakRssMb() {
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss / 1024.0; // KB on Linux
+    }
+
+    // Runs body `repeat` times with the pipeline's output muted; prepare runs untimed before
+    // each repetition
+    template <typename Prepare, typename Body>
+    void measure(const std::string& name, const std::string& unit, uint64_t items, uint64_t bytes, Prepare prepare, Body body) {
+        NullBuffer null;
+        double best = 1e300, total = 0;
+        for (int r = 0; r < repeat; r++) {
+            std::streambuf* console = std::cout.rdbuf(&null);
+            prepare();
+            auto start = std::chrono::high_resolution_clock::now();
+            body();
+            double seconds = secondsSince(start);
+            std::cout.rdbuf(console);
+            best = std::min(best, seconds);
+            total += seconds;
+        }
+        Phase phase{name, unit, best, total / repeat, items, bytes, peakRssMb()};
+        std::cout << "   ⏱️  " << std::left << std::setw(13) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(10) << best * 1000 << " ms  " << std::scientific << std::setprecision(3)
+                  << items / best << " " << unit << "/s  peak RSS " << std::fixed << std::setprecision(0)
+                  << phase.peak_rss_mb << " MB" << std::endl;
+        phases.push_back(phase);
+    }
+
+    // scale levels of quadrant choices per edge; node labels are shuffled into sparse wiki
+    // IDs (about 4x the node count, like the real dumps) so the hubs aren't the low IDs
+    void generateRmat(const std::string& filename) {
+        const int64_t n = int64_t(1) << scale;
+        const int64_t m = n * edge_factor;
+        std::mt19937_64 rng(seed);
+        std::vector<int> wiki_id(n);
+        std::iota(wiki_id.begin(), wiki_id.end(), 0);
+        std::shuffle(wiki_id.begin(), wiki_id.end(), rng);
+        for (int64_t v = 0; v < n; v++) wiki_id[v] = 4 * wiki_id[v] + (v & 3) + 1;
+
+        std::string tmp_filename = filename + ".tmp";
+        std::ofstream file(tmp_filename, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("Cannot create " + tmp_filename);
+        }
+        std::string buffer = "page_id_from\tpage_title_from\tpage_id_to\tpage_title_to\n";
+        char digits[16];
+        auto field = [&](int64_t value) {
+            char* end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+            buffer.append(digits, end);
+        };
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        for (int64_t e = 0; e < m; e++) {
+            int64_t from = 0, to = 0;
+            for (int level = 0; level < scale; level++) {
+                double p = uniform(rng);
+                int64_t bit = int64_t(1) << level;
+                if (p < RMAT_A) {
+                } else if (p < RMAT_A + RMAT_B) {
+                    to |= bit;
+                } else if (p < RMAT_A + RMAT_B + RMAT_C) {
+                    from |= bit;
+                } else {
+                    from |= bit;
+                    to |= bit;
+                }
+            }
+            field(wiki_id[from]);
+            buffer += "\tPage_";
+            field(from);
+            buffer += '\t';
+            field(wiki_id[to]);
+            buffer += "\tPage_";
+            field(to);
+            buffer += '\n';
+            if (buffer.size() > (1 << 20)) {
+                file.write(buffer.data(), buffer.size());
+                buffer.clear();
+            }
+        }
+        file.write(buffer.data(), buffer.size());
+        file.close();
+        if (!file) {
+            throw std::runtime_error("Cannot write " + tmp_filename);
+        }
+        std::filesystem::rename(tmp_filename, filename);
+    }
+
+    // Zero-copy line scanning and field parsing of the whole file on one thread
+    void benchParse(const std::string& filename, uint64_t file_bytes) {
+        MappedFile file;
+        file.open(filename);
+        int64_t lines = std::count(file.data(), file.data() + file.size(), '\n');
+        measure("parse", "lines", lines, file_bytes, [&] { edge_wiki_ids.clear(); }, [&] {
+            EdgeLineScanner scanner(file.data(), file.data() + file.size());
+            std::string_view header;
+            scanner.nextLine(header);
+            EdgeLine edge;
+            while (scanner.next(edge)) {
+                edge_wiki_ids.push_back(edge.from_id);
+                edge_wiki_ids.push_back(edge.to_id);
+            }
+        });
+        edge_count = edge_wiki_ids.size() / 2;
+        unique_ids = edge_wiki_ids;
+        std::sort(unique_ids.begin(), unique_ids.end());
+        unique_ids.erase(std::unique(unique_ids.begin(), unique_ids.end()), unique_ids.end());
+        nodes = unique_ids.size();
+    }
+
+    // Building the wiki_id -> dense ID map, then translating every edge endpoint
+    void benchIdMap() {
+        WikiIdMap map;
+        measure("id_map", "lookups", edge_wiki_ids.size(), 0, [&] { dense_edges = edge_wiki_ids; }, [&] {
+            map.build(unique_ids);
+            map.findBatch(dense_edges.data(), dense_edges.size());
+        });
+    }
+
+    void benchDegreeCount() {
+        std::vector<int> outdegree, indegree;
+        measure("degree_count", "edges", edge_count, 0, [] {}, [&] {
+            outdegree.assign(nodes, 0);
+            indegree.assign(nodes, 0);
+            countDegrees(dense_edges.data(), edge_count, outdegree.data(), indegree.data());
+        });
+        std::vector<int>().swap(edge_wiki_ids);
+        std::vector<int>().swap(dense_edges);
+    }
+
+    // The whole ingest: parallel scan, ID mapping, degrees, CSR and in-edges, titles
+    void benchIngest(const std::string& filename, uint64_t file_bytes) {
+        measure("ingest", "edges", edge_count, file_bytes, [&] {
+            pagerank.reset();
+            pagerank = std::make_unique<StreamingENWikiPageRank>();
+            pagerank->num_threads = threads;
+        }, [&] {
+            pagerank->ingest(filename);
+        });
+    }
+
+    // One Jacobi pull sweep plus the fused post-sweep pass
+    void benchSweep() {
+        StreamingENWikiPageRank& graph = *pagerank;
+        const double alpha = 0.9;
+        graph.withPrecision([&](auto store, auto) {
+            using Store = decltype(store);
+            Store* ranks = graph.probability.data<Store>();
+            graph.dangling_mass = graph.postSweep(ranks, ranks, alpha).second;
+        });
+        measure("sweep", "edges", graph.total_edges, 0, [] {}, [&] {
+            graph.memoryPageRankIteration(alpha);
+            graph.probability.swap(graph.new_probability);
+        });
+    }
+
+    // The top and bottom 100 every pagerank_iter_XX.json selects
+    void benchTopK() {
+        StreamingENWikiPageRank& graph = *pagerank;
+        auto score = [&](int v) { return graph.probability[v]; };
+        measure("top_k", "nodes", graph.N, 0, [] {}, [&] {
+            selectTopK(graph.N, graph.num_threads, graph.topView(100, score), graph.bottomView(100, score));
+        });
+    }
+
+    // titles.json for every node (the largest report), formatted and durably written
+    void benchJson() {
+        StreamingENWikiPageRank& graph = *pagerank;
+        const int year = 0;
+        std::string previous_directory = std::filesystem::current_path();
+        std::filesystem::current_path(directory);
+        graph.ensureYearDirectoryExists(year);
+        graph.all_titles = true;
+        std::string titles_filename = graph.getYearDirectory(year) + "titles.json";
+        measure("json", "titles", graph.N, 0, [&] { graph.lookupTitlesForNeededIds(); }, [&] {
+            graph.saveTitles(year);
+            graph.output_writer.flush();
+        });
+        phases.back().bytes = std::filesystem::file_size(titles_filename);
+        std::filesystem::current_path(previous_directory);
+    }
+};
+
+int main(int argc, char* argv[]) {
+    PageRankBench bench;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--scale" && i + 1 < argc) {
+            bench.scale = std::atoi(argv[++i]);
+        } else if (arg == "--edge-factor" && i + 1 < argc) {
+            bench.edge_factor = std::atoi(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            bench.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--repeat" && i + 1 < argc) {
+            bench.repeat = std::atoi(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            bench.threads = std::atoi(argv[++i]);
+        } else if (arg == "--dir" && i + 1 < argc) {
+            bench.directory = argv[++i];
+        } else if (arg == "--out" && i + 1 < argc) {
+            bench.results_filename = argv[++i];
+        }
+    }
+
+    try {
+        std::cout << "🏁 enwiki_pagerank phase benchmarks" << std::endl;
+        std::cout << "💡 Usage: ./bench_pagerank [options]" << std::endl;
+        std::cout << "   --scale S        R-MAT graph with 2^S node labels (default: 17)" << std::endl;
+        std::cout << "   --edge-factor E  Edges per node label (default: 16)" << std::endl;
+        std::cout << "   --seed X         Generator seed; the graph file is reused per (S, E, X) (default: 1)" << std::endl;
+        std::cout << "   --repeat R       Runs per phase; the best time is reported (default: 3)" << std::endl;
+        std::cout << "   --threads N      Worker threads for the parallel phases (default: all cores)" << std::endl;
+        std::cout << "   --dir D          Graphs, scratch output and results (default: bench)" << std::endl;
+        std::cout << "   --out F          Results JSON (default: <dir>/results-s<S>.json)" << std::endl;
+
+        if (bench.scale < 1 || bench.scale > 26 || bench.edge_factor < 1 || bench.repeat < 1) {
+            throw std::runtime_error("--scale must be in [1, 26], --edge-factor and --repeat at least 1");
+        }
+        if ((int64_t(1) << bench.scale) * bench.edge_factor > INT_MAX) {
+            throw std::runtime_error("2^scale * edge factor must fit in an int (the graph's edge count)");
+        }
+        bench.run();
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,724 @@
+// Self-checks for enwiki_pagerank.cpp that need no downloaded dump: each check builds what it
+// needs in memory (or from a small generated edge list) and fails loudly. Run with make check.
+
+#define ENWIKI_PAGERANK_NO_MAIN
+#include "enwiki_pagerank.cpp"
+
+#include <future>
+
+class PageRankChecks {
+public:
+    int run() {
+        check("year pipeline releases the budget when a solve throws", [&] { yearPipelineSolveFailure(); });
+        check("ingest assigns the same IDs and CSRs on 1, 3 and 8 threads", [&] { ingestThreadIndependent(); });
+        check("pull sweep matches the serial push reference", [&] { pullSweepMatchesReference(); });
+        check("pull sweep ranks are bit-identical on 1 and 4 threads", [&] { pullSweepThreadIndependent(); });
+        check("top-k selection matches a sorted prefix, ties included", [&] { selectTopKMatchesSortPrefix(); });
+        check("compressed in-edges decode to the sorted plain lists", [&] { compressedInEdgesRoundTrip(); });
+        check("JSON output keeps the bytes of the ostream formatting it replaced", [&] { jsonWriterMatchesOstream(); });
+        check("serve rejects arguments that aren't numbers", [&] { serveRejectsNonNumbers(); });
+        check("command-line numbers must parse in full", [&] { parseNumberIsFullMatch(); });
+        check("graph cache rejects sections outside the file", [&] { graphCacheValidation(); });
+        check("local PPR push stays within its residual of power iteration", [&] { localPprMatchesPowerIteration(); });
+        check("warm start carries ranks over by wiki_id and sums to 1", [&] { warmStartCarriesRanksByWikiId(); });
+        check("edge deltas land within their error bound of a full solve", [&] { edgeDeltaMatchesFullSolve(); });
+        std::cout << (failures == 0 ? "✅ All checks passed" : "❌ " + std::to_string(failures) + " check(s) failed") << std::endl;
+        return failures == 0 ? 0 : 1;
+    }
+
+private:
+    int failures = 0;
+
+    template <typename Fn>
+    void check(const std::string& name, Fn fn) {
+        try {
+            fn();
+            std::cout << "   ✓ " << name << std::endl;
+        } catch (const std::exception& e) {
+            failures++;
+            std::cout << "   ✗ " << name << ": " << e.what() << std::endl;
+        }
+    }
+
+    static void expect(bool condition, const std::string& message) {
+        if (!condition) throw std::runtime_error(message);
+    }
+
+    // Runs fn with std::cout captured instead of printed, for the progress output of the
+    // phases under test; returns what was printed
+    template <typename Fn>
+    static std::string quietly(Fn fn) {
+        std::ostringstream captured;
+        std::streambuf* previous = std::cout.rdbuf(captured.rdbuf());
+        try {
+            fn();
+        } catch (...) {
+            std::cout.rdbuf(previous);
+            throw;
+        }
+        std::cout.rdbuf(previous);
+        return captured.str();
+    }
+
+    // A random edge list in the dump's TSV layout, with self-loops, repeated links and
+    // dangling pages, written to a temp file. With varied_titles a page's title changes from
+    // line to line, so only the first occurrence in the file is right.
+    static std::string writeRandomGraph(const std::string& name, int pages, int links, uint64_t seed,
+                                        bool varied_titles = false) {
+        std::string filename = (std::filesystem::temp_directory_path() / name).string();
+        std::ofstream file(filename);
+        file << "page_id_from\tpage_title_from\tpage_id_to\tpage_title_to\n";
+        std::mt19937_64 rng(seed);
+        std::uniform_int_distribution<int> source(0, pages / 2), target(0, pages - 1);
+        for (int e = 0; e < links; e++) {
+            int from = source(rng), to = target(rng);
+            std::string suffix = varied_titles ? "_v" + std::to_string(e % 5) : "";
+            file << 3 * from + 7 << "\tPage_" << from << suffix << "\t" << 3 * to + 7 << "\tPage_" << to << suffix << "\n";
+        }
+        if (!file) throw std::runtime_error("Cannot write " + filename);
+        return filename;
+    }
+
+    // Year 1's prepare can't get its reservation while year 0 holds the budget; when year 0's
+    // solve throws, the pipeline must release year 0 before joining the prefetch
+    void yearPipelineSolveFailure() {
+        auto outcome = std::async(std::launch::async, [] {
+            MemoryBudget budget(100);
+            try {
+                pipelineYears(2, [&](size_t) {
+                    budget.reserve(80);
+                    return std::make_unique<int>(0);
+                }, [&](size_t, int&) {
+                    throw std::runtime_error("solve failed");
+                }, [&](size_t) {
+                    budget.release(80);
+                });
+            } catch (const std::runtime_error& e) {
+                return std::string(e.what());
+            }
+            return std::string("no exception");
+        });
+        if (outcome.wait_for(std::chrono::seconds(10)) != std::future_status::ready) {
+            std::cout << "   ✗ year pipeline hangs when a solve throws under a tight budget" << std::endl;
+            std::_Exit(1); // The pipeline thread can't be joined
+        }
+        expect(outcome.get() == "solve failed", "the solve's exception should propagate");
+    }
+
+    template <typename T>
+    static bool sameArray(const T* a, const T* b, size_t count) {
+        return count == 0 || std::memcmp(a, b, count * sizeof(T)) == 0;
+    }
+
+    // Dense IDs, titles and both CSRs must not depend on how the file was split across threads
+    void ingestThreadIndependent() {
+        std::string filename = writeRandomGraph("check_pagerank_ingest.tsv", 60000, 400000, 5, true);
+        std::vector<std::unique_ptr<StreamingENWikiPageRank>> runs;
+        for (int threads : {1, 3, 8}) {
+            runs.push_back(std::make_unique<StreamingENWikiPageRank>());
+            runs.back()->num_threads = threads;
+            quietly([&] { runs.back()->ingest(filename); });
+        }
+        std::filesystem::remove(filename);
+
+        const StreamingENWikiPageRank& one = *runs[0];
+        expect(std::is_sorted(one.our_id_to_wiki_id.begin(), one.our_id_to_wiki_id.end()), "dense IDs should follow wiki_id order");
+        for (size_t r = 1; r < runs.size(); r++) {
+            const StreamingENWikiPageRank& other = *runs[r];
+            std::string threads = std::to_string(other.num_threads) + " threads";
+            expect(other.N == one.N && other.total_edges == one.total_edges, threads + ": graph size differs");
+            expect(other.our_id_to_wiki_id == one.our_id_to_wiki_id, threads + ": our_id_to_wiki_id differs");
+            expect(sameArray(other.csr_offsets.data(), one.csr_offsets.data(), one.N + 1) &&
+                   sameArray(other.csr_targets.data(), one.csr_targets.data(), one.total_edges), threads + ": out-CSR differs");
+            expect(sameArray(other.in_offsets.data(), one.in_offsets.data(), one.N + 1) &&
+                   sameArray(other.in_sources.data(), one.in_sources.data(), one.total_edges), threads + ": in-CSR differs");
+            expect(sameArray(other.title_offsets.data(), one.title_offsets.data(), one.N + 1) &&
+                   sameArray(other.title_chars.data(), one.title_chars.data(), one.title_chars.size()), threads + ": titles differ");
+        }
+    }
+
+    // jacobiSweep gathers over in-edges in parallel; referenceSweep scatters over out-edges
+    // serially. Over several iterations on a graph spanning more than one rank chunk, every
+    // rank should agree to 1e-12 relative.
+    void pullSweepMatchesReference() {
+        std::string filename = writeRandomGraph("check_pagerank_sweep.tsv", 90000, 600000, 8);
+        StreamingENWikiPageRank pagerank;
+        pagerank.num_threads = 3;
+        quietly([&] { pagerank.ingest(filename); });
+        std::filesystem::remove(filename);
+        expect(pagerank.N > RANK_CHUNK, "test graph should span more than one rank chunk");
+
+        const double alpha = 0.85;
+        const int N = pagerank.N;
+        std::vector<double> reference(N);
+        double* ranks = pagerank.probability.data<double>();
+        for (int iteration = 0; iteration < 5; iteration++) {
+            double dangling = 0.0;
+            for (int v = 0; v < N; v++) {
+                if (pagerank.outdegree[v] == 0) dangling += ranks[v];
+            }
+            pagerank.referenceSweep(reference.data(), alpha, (alpha * dangling + 1.0 - alpha) / N);
+
+            quietly([&] {
+                pagerank.dangling_mass = pagerank.postSweep(ranks, ranks, alpha).second;
+                pagerank.memoryPageRankIteration(alpha);
+            });
+            const double* pulled = pagerank.new_probability.data<double>();
+            for (int v = 0; v < N; v++) {
+                double error = std::abs(pulled[v] - reference[v]) / reference[v];
+                if (error > 1e-12) {
+                    std::ostringstream message;
+                    message << "iteration " << iteration << ", node " << v << ": relative error " << error;
+                    throw std::runtime_error(message.str());
+                }
+            }
+            pagerank.probability.swap(pagerank.new_probability);
+            ranks = pagerank.probability.data<double>();
+        }
+    }
+
+    // Ranks after a few Jacobi sweeps from the uniform vector on num_threads threads
+    static std::vector<double> sweepRanks(StreamingENWikiPageRank& pagerank, int threads, int iterations) {
+        pagerank.num_threads = threads;
+        pagerank.initializeRankVectors();
+        quietly([&] {
+            double* ranks = pagerank.probability.data<double>();
+            pagerank.dangling_mass = pagerank.postSweep(ranks, ranks, 0.85).second;
+            for (int i = 0; i < iterations; i++) {
+                pagerank.memoryPageRankIteration(0.85);
+                pagerank.probability.swap(pagerank.new_probability);
+            }
+        });
+        const double* ranks = pagerank.probability.data<double>();
+        return std::vector<double>(ranks, ranks + pagerank.N);
+    }
+
+    // The partition and the chunked reductions must not change a single bit, before and after
+    // a reorder, whose in-lists must come out sorted like freshly built ones
+    void pullSweepThreadIndependent() {
+        std::string filename = writeRandomGraph("check_pagerank_threads.tsv", 90000, 600000, 13);
+        StreamingENWikiPageRank pagerank;
+        pagerank.num_threads = 4;
+        quietly([&] { pagerank.ingest(filename); });
+        std::filesystem::remove(filename);
+
+        for (int ordering : {0, 2}) {
+            if (ordering != 0) {
+                pagerank.num_threads = 4;
+                quietly([&] { pagerank.reorderNodes(ordering); });
+                for (int v = 0; v < pagerank.N; v++) {
+                    expect(std::is_sorted(pagerank.in_sources.data() + pagerank.in_offsets[v],
+                                          pagerank.in_sources.data() + pagerank.in_offsets[v + 1]),
+                           "in-list of node " + std::to_string(v) + " isn't sorted after the reorder");
+                }
+            }
+            std::vector<double> serial = sweepRanks(pagerank, 1, 5);
+            std::vector<double> parallel = sweepRanks(pagerank, 4, 5);
+            expect(std::memcmp(serial.data(), parallel.data(), serial.size() * sizeof(double)) == 0,
+                   std::string("ranks differ between 1 and 4 threads with --reorder ") + NODE_ORDERINGS[ordering]);
+        }
+    }
+
+    // Keys from a small range, so most items tie and the shuffled wiki_ids decide; every view
+    // must equal the first k of a full std::sort, for any k and thread count
+    void selectTopKMatchesSortPrefix() {
+        const int n = 50000;
+        StreamingENWikiPageRank pagerank;
+        pagerank.N = n;
+        pagerank.our_id_to_wiki_id.resize(n);
+        std::iota(pagerank.our_id_to_wiki_id.begin(), pagerank.our_id_to_wiki_id.end(), 0);
+        std::mt19937_64 rng(60);
+        std::shuffle(pagerank.our_id_to_wiki_id.begin(), pagerank.our_id_to_wiki_id.end(), rng);
+        std::vector<double> key(n);
+        for (double& value : key) value = (double)(rng() % 100) / 7;
+        const std::vector<int>& wiki_id = pagerank.our_id_to_wiki_id;
+
+        auto score = [&](int v) { return key[v]; };
+        auto even = [&](int v) { return v % 2 == 0; };
+        auto sortedPrefix = [&](int k, auto before, bool evens_only) {
+            std::vector<int> items;
+            for (int v = 0; v < n; v++) {
+                if (!evens_only || v % 2 == 0) items.push_back(v);
+            }
+            std::sort(items.begin(), items.end(), before);
+            items.resize(std::min<size_t>(std::max(k, 0), items.size()));
+            return items;
+        };
+        for (int k : {0, 1, 100, 4099, n / 2 + 1, n + 5}) {
+            std::vector<std::vector<int>> expected = {
+                sortedPrefix(k, [&](int a, int b) { return key[a] != key[b] ? key[a] > key[b] : wiki_id[a] < wiki_id[b]; }, false),
+                sortedPrefix(k, [&](int a, int b) { return key[a] != key[b] ? key[a] < key[b] : wiki_id[a] > wiki_id[b]; }, false),
+                sortedPrefix(k, [&](int a, int b) { return key[a] != key[b] ? key[a] < key[b] : wiki_id[a] < wiki_id[b]; }, true),
+            };
+            for (int threads : {1, 4}) {
+                std::vector<std::vector<int>> selected = selectTopK(n, threads, pagerank.topView(k, score),
+                                                                    pagerank.bottomView(k, score),
+                                                                    pagerank.bottomView(k, score, even, true));
+                for (size_t view = 0; view < expected.size(); view++) {
+                    expect(selected[view] == expected[view], "view " + std::to_string(view) + " with k = " + std::to_string(k)
+                                                             + " on " + std::to_string(threads) + " threads isn't the sorted prefix");
+                }
+            }
+        }
+    }
+
+    // Hand-picked lists around every varint length boundary (gaps of 2^7, 2^14, 2^21 and 2^28)
+    // and runs of single-byte gaps that end inside the decoder's 8-byte word, then random
+    // unsorted lists with repeats; each must decode through withInEdges to exactly the sorted
+    // plain list, with the encoding split across threads
+    void compressedInEdgesRoundTrip() {
+        std::vector<std::vector<int>> lists = {{}, {0}, {INT_MAX}, {5, 5, 5}};
+        for (int boundary : {7, 14, 21, 28}) {
+            int gap = 1 << boundary;
+            lists.push_back({gap - 1, 2 * gap - 1});
+            lists.push_back({gap, 2 * gap, 2 * gap + 1});
+            lists.push_back({1, 2, 3, gap + 3, gap + 4});
+        }
+        for (int singles = 1; singles <= 17; singles++) {
+            for (int tail_gap : {1, 200, 20000, 3000000}) {
+                std::vector<int> list;
+                for (int i = 0; i < singles; i++) list.push_back(i * 3);
+                list.push_back(list.back() + tail_gap);
+                lists.push_back(list);
+            }
+        }
+        std::mt19937_64 rng(12);
+        std::uniform_int_distribution<int> length(0, 40), magnitude(0, 3);
+        for (int i = 0; i < 3000; i++) {
+            std::vector<int> list;
+            int value = 0;
+            for (int e = length(rng); e > 0; e--) {
+                value += (int)(rng() % ((1u << (7 * magnitude(rng))) + 1)); // Gaps up to 2^21
+                list.push_back(value);
+            }
+            std::shuffle(list.begin(), list.end(), rng);
+            lists.push_back(list);
+        }
+
+        StreamingENWikiPageRank pagerank;
+        pagerank.N = lists.size();
+        pagerank.in_offsets.assign(pagerank.N + 1, 0);
+        for (int v = 0; v < pagerank.N; v++) pagerank.in_offsets[v + 1] = pagerank.in_offsets[v] + lists[v].size();
+        pagerank.in_sources.assign(pagerank.in_offsets[pagerank.N], 0);
+        for (int v = 0; v < pagerank.N; v++) {
+            std::copy(lists[v].begin(), lists[v].end(), pagerank.in_sources.data() + pagerank.in_offsets[v]);
+        }
+        pagerank.in_compressed.build(pagerank.in_offsets, pagerank.in_sources, pagerank.N, 3);
+
+        bool compressed = false;
+        pagerank.withInEdges([&](const auto& edges) {
+            compressed = std::is_same_v<std::decay_t<decltype(edges)>, CompressedInEdges>;
+            for (int v = 0; v < pagerank.N; v++) {
+                std::vector<int> decoded, expected = lists[v];
+                std::sort(expected.begin(), expected.end());
+                edges.forEach(v, [&](int u) { decoded.push_back(u); });
+                expect(decoded == expected, "list " + std::to_string(v) + " decodes to " + std::to_string(decoded.size())
+                                            + " sources, not the " + std::to_string(expected.size()) + " stored");
+            }
+        });
+        expect(compressed, "withInEdges should read the compressed lists once they're built");
+    }
+
+    // The escaping JsonWriter replaced: quote, backslash and the named control characters are
+    // escaped, any other byte outside printable ASCII (UTF-8 included) becomes a space
+    static std::string escapeJSON(const std::string& input) {
+        std::string output;
+        for (char c : input) {
+            switch (c) {
+                case '\\': output += "\\\\"; break;
+                case '"':  output += "\\\""; break;
+                case '\b': output += "\\b"; break;
+                case '\f': output += "\\f"; break;
+                case '\n': output += "\\n"; break;
+                case '\r': output += "\\r"; break;
+                case '\t': output += "\\t"; break;
+                default:
+                    if (c >= 0x20 && c <= 0x7E) {
+                        output += c;
+                    } else {
+                        output += ' ';
+                    }
+            }
+        }
+        return output;
+    }
+
+    // Titles and numbers written through JsonWriter (to_chars, escaping straight into the
+    // buffer) must come out byte for byte as the ostream code before it wrote them
+    void jsonWriterMatchesOstream() {
+        std::vector<std::string> titles = {"", "Plain_title", "Say \"cheese\"", "C:\\path\\to", "\"\\\"", "tab\there\nnew\rline",
+                                           std::string("nul\0byte", 8), "\b\f\x01\x1f\x7f", "Zürich", "東京", "emoji 🎉 end"};
+        std::mt19937_64 rng(70);
+        for (int i = 0; i < 200; i++) {
+            std::string title(rng() % 40, ' ');
+            for (char& c : title) c = (char)(rng() & 0xFF);
+            titles.push_back(title);
+        }
+        for (const std::string& title : titles) {
+            JsonWriter writer(16);
+            writer << JsonWriter::quoted(title);
+            expect(writer.take() == "\"" + escapeJSON(title) + "\"", "title \"" + escapeJSON(title) + "\" is escaped differently");
+        }
+
+        std::vector<double> values = {0.0, -0.0, 1.0, -1.0, 0.1, 0.5, 1.0 / 3, 2.0 / 3, 0.125, 2.5, 123456, 1234567, 1e-4, 1e-5,
+                                      9.9999995e-5, 999999.5, 1e15, 1e16, 1e-300, 5e-324, 1e300, std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest(),
+                                      std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()};
+        for (int i = 0; i < 2000; i++) {
+            double value = std::ldexp((double)(rng() >> 11), (int)(rng() % 200) - 150); // 53-bit mantissas over a wide range
+            values.push_back(i % 2 ? value : -value);
+        }
+        for (double value : values) {
+            auto check = [&](auto number, auto manipulator, int precision, const char* format) {
+                std::ostringstream expected;
+                manipulator(expected);
+                if (precision >= 0) expected << std::setprecision(precision);
+                expected << value;
+                JsonWriter writer(16);
+                writer << number;
+                std::string written = writer.take();
+                expect(written == expected.str(), std::string(format) + " of " + expected.str() + " is written as " + written);
+            };
+            check(value, [](std::ostream&) {}, -1, "default format");
+            for (int precision : {2, 3, 6}) {
+                check(JsonWriter::scientific(value, precision), [](std::ostream& out) { out << std::scientific; }, precision, "scientific");
+            }
+            for (int precision : {1, 3}) {
+                check(JsonWriter::fixed(value, precision), [](std::ostream& out) { out << std::fixed; }, precision, "fixed");
+            }
+        }
+        for (int64_t value : {int64_t(0), int64_t(-1), int64_t(1) << 40, std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max()}) {
+            std::ostringstream expected;
+            expected << value;
+            JsonWriter writer(16);
+            writer << value;
+            expect(writer.take() == expected.str(), "integer " + expected.str() + " is written differently");
+        }
+    }
+
+    void serveRejectsNonNumbers() {
+        std::string filename = writeRandomGraph("check_pagerank_serve.tsv", 200, 1000, 22);
+        StreamingENWikiPageRank pagerank;
+        pagerank.num_threads = 1;
+        quietly([&] {
+            pagerank.ingest(filename);
+            pagerank.ensureIdIndex();
+            pagerank.publishRanks(0.85);
+        });
+        std::filesystem::remove(filename);
+
+        std::atomic<bool> recomputing{false};
+        auto startRecompute = [](int, double) { return false; };
+        auto ask = [&](const std::string& request) { return pagerank.answerQuery(request, 3, startRecompute, recomputing); };
+        auto isError = [&](const std::string& request) { return ask(request).rfind("{\"error\"", 0) == 0; };
+        for (const char* bad : {"top abc", "top 5x", "top 1e3", "score", "score page", "incoming 7 many",
+                                "changes -", "recompute two", "recompute 3 high"}) {
+            expect(isError(bad), std::string("\"") + bad + "\" should be rejected, got " + ask(bad));
+        }
+        expect(ask("top 3").find("\"top\": [{") != std::string::npos, "\"top 3\" should list articles, got " + ask("top 3"));
+        expect(!isError("top"), "\"top\" should default to 10");
+        expect(!isError("score 7"), "\"score 7\" should find page 0");
+        expect(!isError("recompute 3 0.5"), "\"recompute 3 0.5\" should be accepted");
+    }
+
+    // What main's flags go through: --threads abc or --ppr 12x must fail, not become 0 or 12
+    void parseNumberIsFullMatch() {
+        int integer = -1;
+        double real = -1.0;
+        uint64_t size = 1;
+        for (const char* bad : {"", "abc", "12x", "1e3", "1.5", " 4", "4 ", "+4", "99999999999"}) {
+            expect(!parseNumber(bad, integer), std::string("\"") + bad + "\" should not parse as an int");
+        }
+        for (const char* bad : {"", "0.9.1", "0.85x", "x0.85", "1e", "--1"}) {
+            expect(!parseNumber(bad, real), std::string("\"") + bad + "\" should not parse as a double");
+        }
+        expect(!parseNumber("-5", size), "\"-5\" should not parse as an unsigned size");
+        expect(parseNumber("-12", integer) && integer == -12, "\"-12\" should parse as an int");
+        expect(parseNumber("0.85", real) && real == 0.85, "\"0.85\" should parse as a double");
+        expect(parseNumber("1e-10", real) && real == 1e-10, "\"1e-10\" should parse as a double");
+        expect(parseNumber("4096", size) && size == 4096, "\"4096\" should parse as an unsigned size");
+    }
+
+    // A saved cache loads; cut short, or with a section moved past the end or over its
+    // neighbour, it's refused (and would be rebuilt) instead of mapped
+    void graphCacheValidation() {
+        std::string filename = writeRandomGraph("check_pagerank_cache.tsv", 500, 3000, 2);
+        std::string cache_filename = filename + ".graph.bin";
+        StreamingENWikiPageRank built;
+        built.num_threads = 1;
+        quietly([&] {
+            built.ingest(filename);
+            built.saveGraphCache(cache_filename);
+        });
+        std::string saved;
+        {
+            std::ifstream file(cache_filename, std::ios::binary);
+            saved.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+        auto loads = [&](const std::string& contents) {
+            {
+                std::ofstream file(cache_filename, std::ios::binary | std::ios::trunc);
+                file << contents;
+            }
+            StreamingENWikiPageRank pagerank;
+            bool loaded = false;
+            quietly([&] { loaded = pagerank.loadGraphCache(cache_filename, filename); });
+            return loaded && pagerank.N == built.N && pagerank.total_edges == built.total_edges;
+        };
+        auto withHeader = [&](auto edit) {
+            std::string contents = saved;
+            edit(*reinterpret_cast<GraphCacheHeader*>(contents.data()));
+            return contents;
+        };
+
+        bool intact = loads(saved);
+        bool truncated = loads(saved.substr(0, saved.size() - 1));
+        bool past_end = loads(withHeader([&](GraphCacheHeader& h) { h.csr_targets_offset = saved.size(); }));
+        bool overlapping = loads(withHeader([&](GraphCacheHeader& h) { h.in_sources_offset = h.in_offsets_offset; }));
+        bool misaligned = loads(withHeader([&](GraphCacheHeader& h) { h.csr_offsets_offset += 4; }));
+        bool wrong_edges = loads(withHeader([&](GraphCacheHeader& h) { h.num_edges -= 1; }));
+        std::filesystem::remove(cache_filename);
+        std::filesystem::remove(filename);
+
+        expect(intact, "an intact cache should load");
+        expect(!truncated, "a truncated cache should be rejected");
+        expect(!past_end, "a section past the end of the file should be rejected");
+        expect(!overlapping, "overlapping sections should be rejected");
+        expect(!misaligned, "a misaligned section should be rejected");
+        expect(!wrong_edges, "an edge count that disagrees with the CSR offsets should be rejected");
+    }
+
+    // Forward push from a linked and a dangling source against power iteration with teleport
+    // and dangling mass sent back to the source, run to convergence: push only underestimates,
+    // and its total shortfall is at most the residual it reports
+    void localPprMatchesPowerIteration() {
+        std::string filename = writeRandomGraph("check_pagerank_ppr.tsv", 3000, 15000, 50);
+        StreamingENWikiPageRank pagerank;
+        pagerank.num_threads = 1;
+        quietly([&] { pagerank.ingest(filename); });
+        std::filesystem::remove(filename);
+
+        const double alpha = 0.85;
+        const int N = pagerank.N;
+        int dangling = std::find(pagerank.outdegree.begin(), pagerank.outdegree.end(), 0) - pagerank.outdegree.begin();
+        expect(pagerank.outdegree[0] > 0 && dangling < N, "test graph should have linked and dangling pages");
+        for (int source : {0, dangling}) {
+            std::vector<double> exact(N, 0.0), next(N);
+            exact[source] = 1.0;
+            for (int iteration = 0; iteration < 300; iteration++) {
+                std::fill(next.begin(), next.end(), 0.0);
+                double dangling_mass = 0.0;
+                for (int u = 0; u < N; u++) {
+                    if (pagerank.outdegree[u] == 0) dangling_mass += exact[u];
+                    for (int64_t e = pagerank.csr_offsets[u]; e < pagerank.csr_offsets[u + 1]; e++) {
+                        next[pagerank.csr_targets[e]] += alpha * exact[u] / pagerank.outdegree[u];
+                    }
+                }
+                next[source] += alpha * dangling_mass + 1.0 - alpha;
+                exact.swap(next);
+            }
+
+            for (double epsilon : {1e-4, 1e-7}) {
+                StreamingENWikiPageRank::LocalPpr push = pagerank.localPpr(source, alpha, "push", epsilon, 0);
+                double distance = 0.0;
+                for (int v = 0; v < N; v++) {
+                    auto it = push.estimate.find(v);
+                    double estimate = it == push.estimate.end() ? 0.0 : it->second;
+                    expect(estimate <= exact[v] + 1e-12, "push should underestimate node " + std::to_string(v));
+                    distance += std::abs(exact[v] - estimate);
+                }
+                std::ostringstream message;
+                message << "source " << source << ", epsilon " << epsilon << ": L1 distance " << distance
+                        << ", reported residual " << push.error_bound;
+                expect(push.work > 0 && distance <= push.error_bound + 1e-12, message.str());
+            }
+        }
+    }
+
+    // Runs fn in a fresh temp directory with a data/ subdirectory, for the phases that write
+    // to data/ and public/ relative to the working directory
+    template <typename Fn>
+    static void inTempDirectory(const std::string& name, Fn fn) {
+        std::filesystem::path previous = std::filesystem::current_path();
+        std::filesystem::path directory = std::filesystem::temp_directory_path() / name;
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory / "data");
+        std::filesystem::current_path(directory);
+        try {
+            fn();
+        } catch (...) {
+            std::filesystem::current_path(previous);
+            std::filesystem::remove_all(directory);
+            throw;
+        }
+        std::filesystem::current_path(previous);
+        std::filesystem::remove_all(directory);
+    }
+
+    // Ranks of one year carried into a graph where some articles are gone and others are new:
+    // carried ranks keep their ratios, new ones get the fallback, and the vector sums to 1.
+    // A different alpha only warns.
+    void warmStartCarriesRanksByWikiId() {
+        inTempDirectory("check_pagerank_warm", [&] {
+            std::string old_filename = writeRandomGraph("check_pagerank_warm_old.tsv", 800, 1500, 40);
+            std::string new_filename = writeRandomGraph("check_pagerank_warm_new.tsv", 500, 2500, 41);
+            StreamingENWikiPageRank old_year;
+            old_year.num_threads = 1;
+            std::map<int, double> saved; // wiki_id -> rank
+            quietly([&] {
+                old_year.ingest(old_filename);
+                old_year.initializeRankVectors();
+                double* ranks = old_year.probability.data<double>();
+                double total = 0.0;
+                for (int v = 0; v < old_year.N; v++) total += ranks[v] = 1 + old_year.our_id_to_wiki_id[v] % 17;
+                for (int v = 0; v < old_year.N; v++) saved[old_year.our_id_to_wiki_id[v]] = ranks[v] /= total;
+                old_year.saveFinalRanks(1998, 0.85);
+            });
+            std::filesystem::remove(old_filename);
+
+            for (const std::string fallback : {"uniform", "mean", "min"}) {
+                StreamingENWikiPageRank pagerank;
+                pagerank.num_threads = 1;
+                std::string output = quietly([&] {
+                    pagerank.ingest(new_filename);
+                    pagerank.warmStartFrom(1998, fallback, fallback == "min" ? 0.9 : 0.85);
+                });
+
+                double carried_sum = 0.0, carried_min = 1.0;
+                int carried = 0;
+                for (int v = 0; v < pagerank.N; v++) {
+                    auto it = saved.find(pagerank.our_id_to_wiki_id[v]);
+                    if (it == saved.end()) continue;
+                    carried++;
+                    carried_sum += it->second;
+                    carried_min = std::min(carried_min, it->second);
+                }
+                double fill = fallback == "mean" ? carried_sum / carried : fallback == "min" ? carried_min : 1.0 / pagerank.N;
+                double total = carried_sum + (pagerank.N - carried) * fill, sum = 0.0;
+                for (int v = 0; v < pagerank.N; v++) {
+                    auto it = saved.find(pagerank.our_id_to_wiki_id[v]);
+                    double expected = (it == saved.end() ? fill : it->second) / total;
+                    sum += pagerank.probability[v];
+                    expect(std::abs(pagerank.probability[v] - expected) <= 1e-12 * expected,
+                           fallback + ": wiki_id " + std::to_string(pagerank.our_id_to_wiki_id[v]) + " starts at the wrong rank");
+                }
+                expect(carried > 0 && carried < pagerank.N && carried < (int)saved.size(), "the years should share only some articles");
+                expect(pagerank.warm_start_carried == carried, fallback + ": wrong number of carried articles");
+                expect(std::abs(sum - 1.0) <= 1e-12, fallback + ": start vector sums to " + std::to_string(sum));
+                bool warned = output.find("was solved with α=0.85") != std::string::npos;
+                expect(warned == (fallback == "min"), fallback + ": a different alpha should warn, the same shouldn't");
+            }
+            std::filesystem::remove(new_filename);
+        });
+    }
+
+    // Converged ranks of the TSV's graph by wiki_id, solved in the current directory
+    static std::map<int, double> solveToConvergence(const std::string& filename, int year) {
+        StreamingENWikiPageRank pagerank;
+        pagerank.num_threads = 2;
+        pagerank.tolerance = 1e-14;
+        quietly([&] {
+            pagerank.ingest(filename);
+            pagerank.runPageRank(0.85, 1000, year);
+        });
+        std::map<int, double> ranks;
+        for (int v = 0; v < pagerank.N; v++) ranks[pagerank.our_id_to_wiki_id[v]] = pagerank.probability[v];
+        return ranks;
+    }
+
+    // Two deltas in a row (the second replays the first) of deletes, repeated and new links,
+    // and a source losing all its links, each checked against a full solve of the graph with
+    // all edits so far: the L1 distance must stay within the reported error bound. Deletes
+    // never remove a page's last link, so both runs see the same articles.
+    void edgeDeltaMatchesFullSolve() {
+        const int year = 1999;
+        inTempDirectory("check_pagerank_delta", [&] {
+            for (int y : {year, year + 1}) std::filesystem::create_directories("public/" + std::to_string(y));
+            std::string filename = writeRandomGraph("check_pagerank_delta.tsv", 3000, 20000, 31);
+            std::vector<std::pair<int, int>> links; // By wiki_id, with the edits so far
+            {
+                std::ifstream file(filename);
+                std::string line, title;
+                std::getline(file, line);
+                int from, to;
+                while (file >> from >> title >> to >> title) links.push_back({from, to});
+            }
+            std::map<int, int> appearances;
+            for (auto [from, to] : links) {
+                appearances[from]++;
+                appearances[to]++;
+            }
+            solveToConvergence(filename, year); // Leaves data/1999.ranks.bin
+
+            std::mt19937_64 rng(32);
+            for (int round = 0; round < 2; round++) {
+                std::ostringstream delta;
+                auto remove = [&](size_t l) {
+                    auto [from, to] = links[l];
+                    if (from == to || appearances[from] == 1 || appearances[to] == 1) return;
+                    appearances[from]--;
+                    appearances[to]--;
+                    delta << "- " << from << " " << to << "\n";
+                    links.erase(links.begin() + l);
+                };
+                auto insert = [&](int from, int to) {
+                    if (from == to || !appearances.count(from) || !appearances.count(to)) return;
+                    appearances[from]++;
+                    appearances[to]++;
+                    delta << "+ " << from << " " << to << "\n";
+                    links.push_back({from, to});
+                };
+                for (int i = 0; i < 15; i++) remove(rng() % links.size());
+                for (int i = 0; i < 3; i++) insert(links[rng() % links.size()].first, links[rng() % links.size()].second);
+                for (int i = 0; i < 3; i++) {
+                    auto link = links[rng() % links.size()];
+                    insert(link.first, link.second); // Repeated link
+                }
+                for (int i = 0; i < 3; i++) insert(3 * (2999 - i - 3 * round) + 7, links[rng() % links.size()].second); // Dangling source
+                if (round == 1) {
+                    int source = links[0].first;
+                    for (size_t l = links.size(); l-- > 0;) {
+                        if (links[l].first == source) remove(l);
+                    }
+                }
+                {
+                    std::ofstream file("delta.txt");
+                    file << delta.str();
+                }
+                StreamingENWikiPageRank pagerank;
+                pagerank.num_threads = 2;
+                quietly([&] {
+                    pagerank.ingest(filename);
+                    pagerank.applyEdgeDelta("delta.txt", 0.85, year, 1e-12);
+                });
+
+                {
+                    std::ofstream file("edited.tsv");
+                    file << "page_id_from\tpage_title_from\tpage_id_to\tpage_title_to\n";
+                    for (auto [from, to] : links) {
+                        file << from << "\tPage_" << (from - 7) / 3 << "\t" << to << "\tPage_" << (to - 7) / 3 << "\n";
+                    }
+                }
+                std::map<int, double> exact = solveToConvergence("edited.tsv", year + 1);
+                expect(exact.size() == (size_t)pagerank.N, "the edited graph should keep every article");
+                double distance = 0.0;
+                for (int v = 0; v < pagerank.N; v++) distance += std::abs(pagerank.probability[v] - exact[pagerank.our_id_to_wiki_id[v]]);
+                std::ostringstream message;
+                message << "delta " << round + 1 << ": L1 distance " << distance << " to the full solve, error bound "
+                        << pagerank.delta_error_bound;
+                expect(pagerank.delta_inserted > 0 && pagerank.delta_deleted > 0, message.str() + " with no edits applied");
+                expect(distance <= pagerank.delta_error_bound + 1e-11, message.str());
+            }
+            std::filesystem::remove(filename);
+        });
+    }
+};
+
+int main() {
+    std::cout << "🧪 enwiki_pagerank self-checks" << std::endl;
+    try {
+        return PageRankChecks().run();
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Error: " << e.what() << std::endl;
+        return 1;
+    }
+}